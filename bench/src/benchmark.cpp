@@ -0,0 +1,114 @@
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "stats.h"
+#include "window/frame_pacer.h"
+
+bool abort_benchmark(const char *name, BenchmarkRun *run)
+{
+    fprintf(stderr, "%-24s FAILED, benchmark aborted\n", name);
+    run->failed.push_back(name);
+    return false;
+}
+
+bool run_benchmark(const char *name, BenchmarkOptions *options, BenchmarkRun *run, std::function<bool(void)> body)
+{
+    for (uint32_t i = 0; i < options->warmup; i++)
+    {
+        if (!body())
+            return abort_benchmark(name, run);
+
+        if (options->after_each)
+            options->after_each();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options->iterations);
+
+    for (uint32_t i = 0; i < options->iterations; i++)
+    {
+        auto start = frame_pacer_now();
+        auto succeeded = body();
+        auto end = frame_pacer_now();
+
+        if (!succeeded)
+            return abort_benchmark(name, run);
+
+        if (options->after_each)
+            options->after_each();
+
+        samples.push_back((double)(end - start));
+    }
+
+    double sum = 0;
+    for (auto sample : samples)
+        sum += sample;
+
+    BenchmarkResult result;
+    result.name = name;
+    result.warmup = options->warmup;
+    result.iterations = options->iterations;
+    result.items = options->items;
+    result.median_ns = percentile(&samples, 0.50);
+    result.p99_ns = percentile(&samples, 0.99);
+    result.mean_ns = sum / samples.size();
+    result.min_ns = *std::min_element(samples.begin(), samples.end());
+    result.max_ns = *std::max_element(samples.begin(), samples.end());
+
+    fprintf(stderr, "%-24s median %12.0fns  p99 %12.0fns  (%u iterations)\n", name, result.median_ns, result.p99_ns, result.iterations);
+
+    run->results.push_back(result);
+
+    return true;
+}
+
+void skip_benchmark(const char *name, const char *reason, BenchmarkRun *run)
+{
+    fprintf(stderr, "%-24s SKIPPED, %s\n", name, reason);
+    run->skipped.push_back({ name, reason });
+}
+
+bool write_benchmark_json(const char *path, BenchmarkRun *run)
+{
+    auto file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n  \"benchmarks\": [");
+
+    for (size_t i = 0; i < run->results.size(); i++)
+    {
+        auto &result = run->results[i];
+
+        fprintf(file, "%s\n    {", i == 0 ? "" : ",");
+        fprintf(file, "\"name\": \"%s\", ", result.name.c_str());
+        fprintf(file, "\"warmup\": %u, ", result.warmup);
+        fprintf(file, "\"iterations\": %u, ", result.iterations);
+        fprintf(file, "\"items\": %u, ", result.items);
+        fprintf(file, "\"median_ns\": %.0f, ", result.median_ns);
+        fprintf(file, "\"p99_ns\": %.0f, ", result.p99_ns);
+        fprintf(file, "\"mean_ns\": %.0f, ", result.mean_ns);
+        fprintf(file, "\"min_ns\": %.0f, ", result.min_ns);
+        fprintf(file, "\"max_ns\": %.0f}", result.max_ns);
+    }
+
+    fprintf(file, "\n  ],\n  \"failed\": [");
+
+    for (size_t i = 0; i < run->failed.size(); i++)
+        fprintf(file, "%s\"%s\"", i == 0 ? "" : ", ", run->failed[i].c_str());
+
+    fprintf(file, "],\n  \"skipped\": [");
+
+    for (size_t i = 0; i < run->skipped.size(); i++)
+    {
+        auto &skip = run->skipped[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"reason\": \"%s\"}", i == 0 ? "" : ",", skip.name.c_str(), skip.reason.c_str());
+    }
+
+    fprintf(file, "%s]\n}\n", run->skipped.empty() ? "" : "\n  ");
+    fclose(file);
+
+    return true;
+}
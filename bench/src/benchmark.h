@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+struct BenchmarkOptions {
+    uint32_t warmup = 10;
+    uint32_t iterations = 100;
+    // Work items per iteration, lets results be compared per event / per call
+    uint32_t items = 1;
+    // Runs after every iteration outside the timed region, e.g. to destroy what the body created
+    std::function<void(void)> after_each;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    uint32_t warmup;
+    uint32_t iterations;
+    uint32_t items;
+    double median_ns;
+    double p99_ns;
+    double mean_ns;
+    double min_ns;
+    double max_ns;
+};
+
+struct BenchmarkSkip {
+    std::string name;
+    std::string reason;
+};
+
+struct BenchmarkRun {
+    std::vector<BenchmarkResult> results;
+    std::vector<std::string> failed;
+    std::vector<BenchmarkSkip> skipped;
+};
+
+// Appends the result to run, unless body returns false in which case the benchmark is aborted and listed as failed
+bool run_benchmark(const char *name, BenchmarkOptions *options, BenchmarkRun *run, std::function<bool(void)> body);
+// Lists a benchmark (or a group of them) that could not run in this environment
+void skip_benchmark(const char *name, const char *reason, BenchmarkRun *run);
+bool write_benchmark_json(const char *path, BenchmarkRun *run);
@@ -0,0 +1,507 @@
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "platform.h"
+#include "window.h"
+#include "renderer/vulkan.h"
+#include "benchmark.h"
+
+const uint32_t WINDOW_EVENTS = 1000;
+const int64_t WINDOW_EVENTS_TIMEOUT_NS = 5000000000;
+
+void bench_window_events(BenchmarkRun *run)
+{
+#if USE_XLIB_WINDOW
+    if (!getenv("DISPLAY"))
+    {
+        skip_benchmark("window_event_dispatch", "DISPLAY is not set (run under Xvfb)", run);
+        return;
+    }
+
+    WindowHandle window;
+    uint32_t received = 0;
+    int64_t deadline_ns = 0;
+
+    WindowOptions options = {
+        width: 640,
+        height: 480,
+        key_pressed: [&](uint32_t key_code) {
+            if (++received == WINDOW_EVENTS)
+                options.shutdown = true;
+        },
+        // Runs after every pass over the queue, ends the loop if events got lost instead of waiting forever
+        frame: [&]() {
+            if (frame_pacer_now() > deadline_ns)
+                options.shutdown = true;
+        },
+    };
+
+    window = create_window(&options);
+    if (!window.display)
+    {
+        skip_benchmark("window_event_dispatch", "could not open display", run);
+        return;
+    }
+
+    XEvent xevent = {};
+    xevent.xkey.type = KeyPress;
+    xevent.xkey.display = window.display;
+    xevent.xkey.window = window.window_id;
+    xevent.xkey.root = DefaultRootWindow(window.display);
+    xevent.xkey.keycode = 38;
+    xevent.xkey.same_screen = True;
+
+    BenchmarkOptions bench_options;
+    bench_options.items = WINDOW_EVENTS;
+
+    run_benchmark("window_event_dispatch", &bench_options, run, [&]() {
+        received = 0;
+        options.shutdown = false;
+        deadline_ns = frame_pacer_now() + WINDOW_EVENTS_TIMEOUT_NS;
+
+        for (uint32_t i = 0; i < WINDOW_EVENTS; i++)
+            XSendEvent(window.display, window.window_id, False, KeyPressMask, &xevent);
+
+        XFlush(window.display);
+
+        run_window_eventloop(&window, &options);
+
+        return received == WINDOW_EVENTS;
+    });
+
+    close_window(&window);
+    XCloseDisplay(window.display);
+#else
+    skip_benchmark("window_event_dispatch", "only implemented for xlib", run);
+#endif
+}
+
+bool create_storage_buffer(Device *device, VkDeviceSize size, VkBuffer *buffer, VkDeviceMemory *memory)
+{
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = size;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device->logicalDevice, &bufferCreateInfo, nullptr, buffer) != VK_SUCCESS)
+        return false;
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device->logicalDevice, *buffer, &requirements);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    // The buffer is never mapped, so the first memory type it allows will do
+    allocateInfo.memoryTypeIndex = __builtin_ctz(requirements.memoryTypeBits);
+
+    if (vkAllocateMemory(device->logicalDevice, &allocateInfo, nullptr, memory) != VK_SUCCESS)
+        return false;
+
+    return vkBindBufferMemory(device->logicalDevice, *buffer, *memory, 0) == VK_SUCCESS;
+}
+
+struct BenchCommands {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VkCommandBuffer buffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+};
+
+bool create_bench_commands(Device *device, BenchCommands *commands)
+{
+    VkCommandPoolCreateInfo poolCreateInfo = {};
+    poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolCreateInfo.queueFamilyIndex = device->graphicsQueueFamilyIndex;
+
+    if (vkCreateCommandPool(device->logicalDevice, &poolCreateInfo, nullptr, &commands->pool) != VK_SUCCESS)
+        return false;
+
+    VkCommandBufferAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.commandPool = commands->pool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(device->logicalDevice, &allocateInfo, &commands->buffer) != VK_SUCCESS)
+        return false;
+
+    VkFenceCreateInfo fenceCreateInfo = {};
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    return vkCreateFence(device->logicalDevice, &fenceCreateInfo, nullptr, &commands->fence) == VK_SUCCESS;
+}
+
+void destroy_bench_commands(Device *device, BenchCommands *commands)
+{
+    vkDestroyFence(device->logicalDevice, commands->fence, nullptr);
+    vkDestroyCommandPool(device->logicalDevice, commands->pool, nullptr);
+}
+
+// Records the command buffer from scratch, submits it and waits for the fence, so every iteration
+// pays for recording, submission and execution
+bool submit_commands(Device *device, BenchCommands *commands, std::function<bool(VkCommandBuffer)> record)
+{
+    if (vkResetCommandPool(device->logicalDevice, commands->pool, 0) != VK_SUCCESS)
+        return false;
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commands->buffer, &beginInfo) != VK_SUCCESS)
+        return false;
+
+    if (!record(commands->buffer))
+        return false;
+
+    if (vkEndCommandBuffer(commands->buffer) != VK_SUCCESS)
+        return false;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commands->buffer;
+
+    if (vkQueueSubmit(device->graphicsQueue, 1, &submitInfo, commands->fence) != VK_SUCCESS)
+        return false;
+
+    if (vkWaitForFences(device->logicalDevice, 1, &commands->fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+        return false;
+
+    return vkResetFences(device->logicalDevice, 1, &commands->fence) == VK_SUCCESS;
+}
+
+VkPipelineLayout create_bench_pipeline_layout(Device *device, VkDescriptorSetLayout set_layout, uint32_t push_constant_size)
+{
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = push_constant_size;
+
+    VkPipelineLayoutCreateInfo layoutCreateInfo = {};
+    layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutCreateInfo.setLayoutCount = 1;
+    layoutCreateInfo.pSetLayouts = &set_layout;
+    layoutCreateInfo.pushConstantRangeCount = push_constant_size > 0 ? 1 : 0;
+    layoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    if (vkCreatePipelineLayout(device->logicalDevice, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    return layout;
+}
+
+// Records and submits the binding work of a frame of draws, one storage buffer per draw: a fresh set,
+// vkUpdateDescriptorSets and vkCmdBindDescriptorSets per draw, against binding the bindless set once and
+// pushing each draw's handle as a push constant. There are no pipelines or shaders in the tree yet, so
+// the draws themselves are left out and only the binding commands are measured.
+void bench_descriptor_binding(BenchmarkRun *run, Device *device, DescriptorAllocator *allocator)
+{
+    const uint32_t DRAWS_PER_SUBMIT = 1000;
+    const VkDeviceSize BUFFER_SIZE = 256;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    BenchCommands commands;
+
+    if (!create_storage_buffer(device, BUFFER_SIZE, &buffer, &memory) || !create_bench_commands(device, &commands))
+    {
+        skip_benchmark("descriptor_binding", "could not create buffer or command buffer", run);
+        destroy_bench_commands(device, &commands);
+        vkDestroyBuffer(device->logicalDevice, buffer, nullptr);
+        vkFreeMemory(device->logicalDevice, memory, nullptr);
+        return;
+    }
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = BUFFER_SIZE;
+
+    BenchmarkOptions bench_options;
+    bench_options.items = DRAWS_PER_SUBMIT;
+
+    auto set_layout = get_descriptor_set_layout(allocator, &binding, 1);
+    auto pipeline_layout = set_layout ? create_bench_pipeline_layout(device, set_layout, 0) : VK_NULL_HANDLE;
+
+    if (pipeline_layout)
+    {
+        uint32_t frame = 0;
+
+        run_benchmark("descriptor_set_bind_submit", &bench_options, run, [&]() {
+            // The previous submit has been waited on, so the pools of this frame slot are free to reset
+            begin_descriptor_frame(allocator, frame++);
+
+            return submit_commands(device, &commands, [&](VkCommandBuffer command_buffer) {
+                for (uint32_t i = 0; i < DRAWS_PER_SUBMIT; i++)
+                {
+                    VkDescriptorSet set;
+                    if (!allocate_descriptor_set(allocator, set_layout, &set))
+                        return false;
+
+                    VkWriteDescriptorSet write = {};
+                    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    write.dstSet = set;
+                    write.dstBinding = 0;
+                    write.descriptorCount = 1;
+                    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    write.pBufferInfo = &bufferInfo;
+
+                    vkUpdateDescriptorSets(device->logicalDevice, 1, &write, 0, nullptr);
+                    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &set, 0, nullptr);
+                }
+
+                return true;
+            });
+        });
+
+        vkDestroyPipelineLayout(device->logicalDevice, pipeline_layout, nullptr);
+    }
+    else
+    {
+        skip_benchmark("descriptor_set_bind_submit", "could not create pipeline layout", run);
+    }
+
+    if (device->bindlessEnabled)
+    {
+        CreateBindlessDescriptorsInfo create_bindless_info;
+        create_bindless_info.max_buffers = DRAWS_PER_SUBMIT;
+
+        BindlessDescriptors bindless;
+        auto created = create_bindless_descriptors(&create_bindless_info, device, &bindless);
+
+        // Every draw gets its own handle, registered up front like resources that stay loaded
+        std::vector<uint32_t> handles(DRAWS_PER_SUBMIT, BINDLESS_INVALID_HANDLE);
+        for (uint32_t i = 0; created && i < DRAWS_PER_SUBMIT; i++)
+        {
+            handles[i] = register_bindless_buffer(&bindless, buffer, 0, BUFFER_SIZE);
+            created = handles[i] != BINDLESS_INVALID_HANDLE;
+        }
+
+        auto bindless_layout = created ? create_bench_pipeline_layout(device, bindless.layout, sizeof(uint32_t)) : VK_NULL_HANDLE;
+
+        if (bindless_layout)
+        {
+            run_benchmark("bindless_push_constant_submit", &bench_options, run, [&]() {
+                return submit_commands(device, &commands, [&](VkCommandBuffer command_buffer) {
+                    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindless_layout, 0, 1, &bindless.set, 0, nullptr);
+
+                    for (uint32_t i = 0; i < DRAWS_PER_SUBMIT; i++)
+                        vkCmdPushConstants(command_buffer, bindless_layout, VK_SHADER_STAGE_ALL, 0, sizeof(uint32_t), &handles[i]);
+
+                    return true;
+                });
+            });
+
+            vkDestroyPipelineLayout(device->logicalDevice, bindless_layout, nullptr);
+        }
+        else
+        {
+            skip_benchmark("bindless_push_constant_submit", "could not set up bindless descriptors", run);
+        }
+
+        destroy_bindless_descriptors(&bindless);
+    }
+    else
+    {
+        skip_benchmark("bindless_push_constant_submit", "descriptor indexing not supported", run);
+    }
+
+    destroy_bench_commands(device, &commands);
+    vkDestroyBuffer(device->logicalDevice, buffer, nullptr);
+    vkFreeMemory(device->logicalDevice, memory, nullptr);
+}
+
+void bench_device(BenchmarkRun *run)
+{
+    CreateDeviceInfo create_device_info;
+    create_device_info.application_name = "bench";
+    create_device_info.engine_name = "bench";
+    create_device_info.enableValidation = false;
+    create_device_info.enableBindless = true;
+
+    Device device;
+    if (!create_device(&create_device_info, &device))
+    {
+        skip_benchmark("device", "no vulkan device (is lavapipe installed?)", run);
+        return;
+    }
+
+    Device instance_only;
+
+    BenchmarkOptions instance_options;
+    instance_options.warmup = 2;
+    instance_options.iterations = 20;
+    instance_options.after_each = [&]() {
+        destroy_device(&instance_only);
+    };
+
+    run_benchmark("instance_create", &instance_options, run, [&]() {
+        return create_instance(&create_device_info, &instance_only);
+    });
+
+    // Only the logical device is recreated, on the instance and physical device picked above
+    destroy_logical_device(&device);
+
+    BenchmarkOptions device_options;
+    device_options.warmup = 2;
+    device_options.iterations = 20;
+    device_options.after_each = [&]() {
+        destroy_logical_device(&device);
+    };
+
+    run_benchmark("device_create", &device_options, run, [&]() {
+        return create_logical_device(&create_device_info, &device);
+    });
+
+    if (!create_logical_device(&create_device_info, &device))
+    {
+        skip_benchmark("descriptor", "could not create device", run);
+        destroy_device(&device);
+        return;
+    }
+
+    CreateDescriptorAllocatorInfo create_allocator_info;
+
+    DescriptorAllocator allocator;
+    if (!create_descriptor_allocator(&create_allocator_info, &device, &allocator))
+    {
+        skip_benchmark("descriptor", "could not create descriptor allocator", run);
+        destroy_device(&device);
+        return;
+    }
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    const uint32_t SETS_PER_FRAME = 1000;
+    uint32_t frame = 0;
+
+    BenchmarkOptions bench_options;
+    bench_options.items = SETS_PER_FRAME;
+
+    run_benchmark("descriptor_frame", &bench_options, run, [&]() {
+        begin_descriptor_frame(&allocator, frame++);
+
+        auto layout = get_descriptor_set_layout(&allocator, &binding, 1);
+        if (!layout)
+            return false;
+
+        for (uint32_t i = 0; i < SETS_PER_FRAME; i++)
+        {
+            VkDescriptorSet set;
+            if (!allocate_descriptor_set(&allocator, layout, &set))
+                return false;
+        }
+
+        return true;
+    });
+
+    bench_descriptor_binding(run, &device, &allocator);
+
+    destroy_descriptor_allocator(&allocator);
+    destroy_device(&device);
+}
+
+void bench_residency(BenchmarkRun *run)
+{
+    const uint32_t RESOURCES = 10000;
+
+    MemoryBudget heap;
+    heap.heap_count = 1;
+    heap.budget[0] = (VkDeviceSize)RESOURCES * 1024;
+
+    ResidencyManager manager;
+    manager.options.min_idle_frames = 1;
+    manager.options.evict = [](const ResidentResource &resource) -> VkDeviceSize {
+        return resource.size;
+    };
+
+    for (uint64_t id = 0; id < RESOURCES; id++)
+        track_resource(&manager, id, ResidencyKinds::BufferResource, 0, 1024);
+
+    BenchmarkOptions bench_options;
+    bench_options.items = RESOURCES;
+
+    // A rotating quarter of the resources goes idle each frame and is brought back later,
+    // so the heap keeps going over budget and every update has to evict
+    run_benchmark("residency_update", &bench_options, run, [&]() {
+        for (uint64_t id = 0; id < RESOURCES; id++)
+        {
+            if (id % 4 == manager.current_frame % 4)
+                continue;
+
+            if (touch_resource(&manager, id) != ResidencyStates::ResidentState)
+                make_resource_resident(&manager, id, 1024);
+        }
+
+        update_residency(&manager, &heap);
+
+        return true;
+    });
+}
+
+void bench_trace(BenchmarkRun *run)
+{
+    const uint32_t TRACES = 10000;
+
+    // Traces go to /dev/null so the terminal doesn't dominate the measurement
+    fflush(stdout);
+    auto saved_stdout = dup(STDOUT_FILENO);
+    auto null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+
+    BenchmarkOptions bench_options;
+    bench_options.items = TRACES;
+
+    run_benchmark("trace", &bench_options, run, [&]() {
+        for (uint32_t i = 0; i < TRACES; i++)
+            TRACE("bench_trace");
+
+        return fflush(stdout) == 0;
+    });
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(null_fd);
+    close(saved_stdout);
+}
+
+int main(int argc, char **argv)
+{
+    auto output_path = argc > 1 ? argv[1] : "bench_results.json";
+
+    BenchmarkRun run;
+
+    bench_window_events(&run);
+    bench_device(&run);
+    bench_residency(&run);
+    bench_trace(&run);
+
+    if (!write_benchmark_json(output_path, &run))
+    {
+        TRACE("FAILED to write benchmark results");
+        return 1;
+    }
+
+    // A skipped benchmark is a broken environment (no Xvfb, no lavapipe), not a pass
+    if (!run.failed.empty() || !run.skipped.empty())
+    {
+        fprintf(stderr, "%zu benchmarks failed, %zu skipped\n", run.failed.size(), run.skipped.size());
+        return 1;
+    }
+
+    return 0;
+}
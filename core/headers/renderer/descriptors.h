@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+#include "trace.h"
+#include "renderer/device.h"
+
+// Bindings sorted by binding index, with pImmutableSamplers cleared and the sampler handles copied
+// into immutable_samplers (one entry per binding, empty when it has none)
+struct DescriptorLayoutKey {
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    std::vector<std::vector<VkSampler>> immutable_samplers;
+
+    bool operator==(const DescriptorLayoutKey &other) const;
+};
+
+struct DescriptorLayoutKeyHash {
+    size_t operator()(const DescriptorLayoutKey &key) const;
+};
+
+struct DescriptorFrame {
+    std::vector<VkDescriptorPool> pools;
+};
+
+// Hands out descriptor sets from per-frame pools that are reset in bulk,
+// adding new pools whenever the current one runs out.
+struct DescriptorAllocator {
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t sets_per_pool = 0;
+    uint32_t current_frame = 0;
+    std::vector<VkDescriptorPoolSize> pool_sizes;
+    std::vector<DescriptorFrame> frames;
+    std::vector<VkDescriptorPool> free_pools;
+    std::unordered_map<DescriptorLayoutKey, VkDescriptorSetLayout, DescriptorLayoutKeyHash> layout_cache;
+};
+
+struct CreateDescriptorAllocatorInfo {
+    uint32_t frames_in_flight = 2;
+    uint32_t sets_per_pool = 256;
+    // Descriptors of each type per pool, as a multiple of sets_per_pool
+    std::vector<std::pair<VkDescriptorType, float>> pool_ratios = {
+        { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f },
+    };
+};
+
+bool create_descriptor_allocator(CreateDescriptorAllocatorInfo *create_info, Device *device, DescriptorAllocator *allocator);
+void begin_descriptor_frame(DescriptorAllocator *allocator, uint32_t frame_index);
+bool allocate_descriptor_set(DescriptorAllocator *allocator, VkDescriptorSetLayout layout, VkDescriptorSet *set);
+VkDescriptorSetLayout get_descriptor_set_layout(DescriptorAllocator *allocator, const VkDescriptorSetLayoutBinding *bindings, uint32_t binding_count);
+void destroy_descriptor_allocator(DescriptorAllocator *allocator);
+
+// One update-after-bind set holding every texture and storage buffer, indexed by handle from shaders.
+// Binding 0 is the combined image sampler array, binding 1 the storage buffer array.
+const uint32_t BINDLESS_TEXTURE_BINDING = 0;
+const uint32_t BINDLESS_BUFFER_BINDING = 1;
+const uint32_t BINDLESS_INVALID_HANDLE = UINT32_MAX;
+
+// Released handles are held back until their frame slot comes around again, so a descriptor
+// is never rewritten while a frame still in flight may be reading it
+struct BindlessSlots {
+    uint32_t max = 0;
+    uint32_t next = 0;
+    std::vector<uint32_t> free;
+    std::vector<std::vector<uint32_t>> retired;
+    std::vector<bool> in_use;
+};
+
+struct BindlessDescriptors {
+    VkDevice device = VK_NULL_HANDLE;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    uint32_t current_frame = 0;
+    BindlessSlots textures;
+    BindlessSlots buffers;
+};
+
+struct CreateBindlessDescriptorsInfo {
+    uint32_t frames_in_flight = 2;
+    uint32_t max_textures = 16384;
+    uint32_t max_buffers = 4096;
+    VkShaderStageFlags stages = VK_SHADER_STAGE_ALL;
+};
+
+bool create_bindless_descriptors(CreateBindlessDescriptorsInfo *create_info, Device *device, BindlessDescriptors *bindless);
+void begin_bindless_frame(BindlessDescriptors *bindless, uint32_t frame_index);
+uint32_t register_bindless_texture(BindlessDescriptors *bindless, VkImageView image_view, VkSampler sampler, VkImageLayout image_layout);
+uint32_t register_bindless_buffer(BindlessDescriptors *bindless, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+bool release_bindless_texture(BindlessDescriptors *bindless, uint32_t handle);
+bool release_bindless_buffer(BindlessDescriptors *bindless, uint32_t handle);
+void destroy_bindless_descriptors(BindlessDescriptors *bindless);
@@ -9,14 +9,37 @@
 struct Device {
     VkInstance instance = VK_NULL_HANDLE;
     VkDebugReportCallbackEXT debugReportCallback = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice logicalDevice = VK_NULL_HANDLE;
+    VkQueue graphicsQueue = VK_NULL_HANDLE;
+    uint32_t graphicsQueueFamilyIndex = 0;
+    bool bindlessEnabled = false;
+    bool memoryBudgetEnabled = false;
+};
+
+struct MemoryBudget {
+    uint32_t heap_count = 0;
+    VkDeviceSize budget[VK_MAX_MEMORY_HEAPS] = {};
+    VkDeviceSize usage[VK_MAX_MEMORY_HEAPS] = {};
+    // False when VK_EXT_memory_budget is missing, budget is then the heap size and usage is left untouched
+    bool usage_reported = false;
 };
 
 struct CreateDeviceInfo {
     const char * application_name;
     const char * engine_name;
     bool enableValidation;
+    bool enableBindless = false;
 };
 
 bool create_device(CreateDeviceInfo* create_device_info, Device* device);
 
-void destroy_device(Device* device);
\ No newline at end of file
+// The individual steps of create_device, exposed so they can be timed separately
+bool create_instance(CreateDeviceInfo* create_device_info, Device* device);
+bool pick_physical_device(Device* device);
+bool create_logical_device(CreateDeviceInfo* create_device_info, Device* device);
+void destroy_logical_device(Device* device);
+
+void update_memory_budget(Device* device, MemoryBudget* memory_budget);
+
+void destroy_device(Device* device);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+#include "trace.h"
+#include "renderer/device.h"
+
+enum ResidencyKinds {
+    TextureResource,
+    BufferResource,
+};
+
+enum ResidencyStates {
+    ResidentState,
+    // Still usable but shrunk by the evict callback (e.g. mips dropped), size is less than full_size
+    DemotedState,
+    // Nothing left on the gpu, has to be uploaded again before use
+    EvictedState,
+};
+
+struct ResidentResource {
+    uint64_t id;
+    ResidencyKinds kind;
+    uint32_t heap_index;
+    // Bytes currently on the gpu, and what it takes when fully resident
+    VkDeviceSize size;
+    VkDeviceSize full_size;
+    uint64_t last_used_frame;
+    ResidencyStates state;
+};
+
+struct ResidencyCounters {
+    VkDeviceSize heap_budget[VK_MAX_MEMORY_HEAPS] = {};
+    VkDeviceSize heap_usage_before_eviction[VK_MAX_MEMORY_HEAPS] = {};
+    // Usage after the last eviction pass, with reported usage this is an estimate until the driver catches up
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS] = {};
+    uint64_t evictions = 0;
+    uint64_t demotions = 0;
+    VkDeviceSize evicted_bytes = 0;
+};
+
+struct ResidencyOptions {
+    // Start evicting once a heap goes above budget_fraction of its budget, and keep going until target_fraction
+    float budget_fraction = 0.9f;
+    float target_fraction = 0.8f;
+    // Resources used within this many frames may still be in flight and are never evicted
+    uint32_t min_idle_frames = 3;
+
+    // Frees or shrinks the resource and returns the number of bytes released.
+    // Releasing less than its size (e.g. dropping mip levels) demotes it instead of evicting it.
+    std::function<VkDeviceSize(const ResidentResource &)> evict;
+};
+
+struct ResidencyManager {
+    ResidencyOptions options;
+    // Advanced by update_residency, touches are stamped with it
+    uint64_t current_frame = 0;
+    std::unordered_map<uint64_t, ResidentResource> resources;
+    VkDeviceSize tracked_usage[VK_MAX_MEMORY_HEAPS] = {};
+    ResidencyCounters counters;
+};
+
+bool track_resource(ResidencyManager *manager, uint64_t id, ResidencyKinds kind, uint32_t heap_index, VkDeviceSize size);
+void untrack_resource(ResidencyManager *manager, uint64_t id);
+ResidencyStates touch_resource(ResidencyManager *manager, uint64_t id);
+void make_resource_resident(ResidencyManager *manager, uint64_t id, VkDeviceSize size);
+void update_residency(ResidencyManager *manager, MemoryBudget *memory_budget);
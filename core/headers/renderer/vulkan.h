@@ -1,3 +1,5 @@
 #pragma once
 
-#include "device.h"
\ No newline at end of file
+#include "device.h"
+#include "descriptors.h"
+#include "residency.h"
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+// Nearest-rank percentile, fraction in [0, 1]. Reorders samples.
+inline double percentile(std::vector<double> *samples, double fraction)
+{
+    if (samples->empty())
+        return 0;
+
+    auto index = (size_t)(fraction * (samples->size() - 1) + 0.5);
+    std::nth_element(samples->begin(), samples->begin() + index, samples->end());
+
+    return (*samples)[index];
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+struct FramePacerReport {
+    uint64_t frames = 0;
+    double frame_time_mean_ms = 0;
+    double frame_time_variance = 0; // ms squared
+    double latency_p50_ms = 0;
+    double latency_p90_ms = 0;
+    double latency_p99_ms = 0;
+};
+
+struct FramePacer {
+    int64_t frame_interval_ns = 0;
+    int64_t spin_threshold_ns = 0;
+    int64_t next_deadline_ns = 0;
+    bool waiting = false;
+    int64_t last_present_ns = 0;
+    uint64_t frames = 0;
+
+    // Receive times of input events that have not been presented yet
+    std::vector<int64_t> pending_inputs;
+
+    // Ring buffers of the most recent samples, used for the percentiles and variance
+    uint32_t history_size = 0;
+    std::vector<double> latency_history_ms;
+    std::vector<double> frame_time_history_ms;
+    uint32_t latency_cursor = 0;
+    uint32_t frame_time_cursor = 0;
+
+    FILE *csv = nullptr;
+};
+
+struct CreateFramePacerInfo {
+    // 0 disables pacing, frames are then only measured
+    uint32_t target_fps = 60;
+    // How long before a deadline to stop sleeping and start spinning, covers scheduler wakeup jitter
+    uint32_t spin_threshold_us = 1000;
+    uint32_t history_size = 1024;
+    // Rows are "frame" samples (start_ms is the previous present) and "input" samples (start_ms is when
+    // the event was received), duration_ms is the frame time or the input latency
+    const char *csv_path = nullptr;
+};
+
+int64_t frame_pacer_now();
+
+bool create_frame_pacer(CreateFramePacerInfo *create_info, FramePacer *pacer);
+void frame_pacer_wait(FramePacer *pacer);
+bool frame_pacer_wait_for_events(FramePacer *pacer, int fd);
+// received_ns is when the event was read off the connection, from frame_pacer_now()
+void frame_pacer_input(FramePacer *pacer, int64_t received_ns);
+// Call right after queueing the present, closes the frame and the latency of every input received since the last one
+void frame_pacer_present(FramePacer *pacer);
+void frame_pacer_report(FramePacer *pacer, FramePacerReport *report);
+void destroy_frame_pacer(FramePacer *pacer);
@@ -2,6 +2,8 @@
 
 #include <functional>
 
+struct FramePacer;
+
 struct WindowOptions {
     bool shutdown = false;
     uint32_t width = 1920;
@@ -14,6 +16,11 @@ struct WindowOptions {
     std::function<void(uint32_t, uint32_t)> resized;
     std::function<void(void)> focused;
     std::function<void(void)> lost_focus;
+
+    // Called once per loop iteration after pending events are handled, turns the event loop into a render loop
+    std::function<void(void)> frame;
+    // Optional, paces frame and timestamps input events for latency tracking
+    FramePacer *pacer = nullptr;
 };
 
 enum WindowModes {
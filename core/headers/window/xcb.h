@@ -3,11 +3,13 @@
 // https://www.codeproject.com/articles/1089819/an-introduction-to-xcb-programming
 
 #include <iostream>
+#include <deque>
 #include <string.h>
 #include <xcb/xcb.h>
 
 #include "trace.h"
 #include "window/options.h"
+#include "window/frame_pacer.h"
 
 struct XcbWindow
 {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <deque>
 #include <string.h>
 #include <stdio.h>
 #include <X11/Xlib.h>
@@ -9,6 +10,7 @@
 
 #include "trace.h"
 #include "window/options.h"
+#include "window/frame_pacer.h"
 
 struct XlibWindow
 {
@@ -0,0 +1,446 @@
+#include "renderer/descriptors.h"
+
+#include <algorithm>
+#include <functional>
+
+bool DescriptorLayoutKey::operator==(const DescriptorLayoutKey &other) const
+{
+	if (bindings.size() != other.bindings.size())
+		return false;
+
+	for (size_t i = 0; i < bindings.size(); i++)
+	{
+		auto &a = bindings[i];
+		auto &b = other.bindings[i];
+
+		if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags)
+			return false;
+	}
+
+	return immutable_samplers == other.immutable_samplers;
+}
+
+size_t DescriptorLayoutKeyHash::operator()(const DescriptorLayoutKey &key) const
+{
+	size_t hash = key.bindings.size();
+
+	for (auto &binding : key.bindings)
+	{
+		size_t packed = binding.binding | (binding.descriptorType << 8) | ((size_t)binding.descriptorCount << 16) | ((size_t)binding.stageFlags << 40);
+		hash ^= std::hash<size_t>()(packed) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+
+	for (auto &samplers : key.immutable_samplers)
+	{
+		for (auto sampler : samplers)
+			hash ^= std::hash<VkSampler>()(sampler) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+
+	return hash;
+}
+
+VkDescriptorPool create_descriptor_pool(DescriptorAllocator *allocator)
+{
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = allocator->sets_per_pool;
+	poolCreateInfo.poolSizeCount = (uint32_t)allocator->pool_sizes.size();
+	poolCreateInfo.pPoolSizes = allocator->pool_sizes.data();
+
+	VkDescriptorPool pool;
+	if (vkCreateDescriptorPool(allocator->device, &poolCreateInfo, nullptr, &pool) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	return pool;
+}
+
+VkDescriptorPool grab_descriptor_pool(DescriptorAllocator *allocator)
+{
+	if (!allocator->free_pools.empty())
+	{
+		auto pool = allocator->free_pools.back();
+		allocator->free_pools.pop_back();
+		return pool;
+	}
+
+	TRACE("create_descriptor_pool");
+
+	return create_descriptor_pool(allocator);
+}
+
+bool create_descriptor_allocator(CreateDescriptorAllocatorInfo *create_info, Device *device, DescriptorAllocator *allocator)
+{
+	if (create_info->frames_in_flight == 0 || create_info->sets_per_pool == 0)
+		return false;
+
+	allocator->device = device->logicalDevice;
+	allocator->sets_per_pool = create_info->sets_per_pool;
+	allocator->current_frame = 0;
+	allocator->frames.resize(create_info->frames_in_flight);
+
+	for (auto &ratio : create_info->pool_ratios)
+	{
+		auto count = (uint32_t)(ratio.second * create_info->sets_per_pool);
+		allocator->pool_sizes.push_back({ ratio.first, std::max(count, 1u) });
+	}
+
+	return true;
+}
+
+void begin_descriptor_frame(DescriptorAllocator *allocator, uint32_t frame_index)
+{
+	allocator->current_frame = frame_index % (uint32_t)allocator->frames.size();
+
+	// Everything allocated the last time this frame slot was used is released in one go
+	auto &frame = allocator->frames[allocator->current_frame];
+	for (auto pool : frame.pools)
+	{
+		vkResetDescriptorPool(allocator->device, pool, 0);
+		allocator->free_pools.push_back(pool);
+	}
+
+	frame.pools.clear();
+}
+
+bool allocate_descriptor_set(DescriptorAllocator *allocator, VkDescriptorSetLayout layout, VkDescriptorSet *set)
+{
+	auto &frame = allocator->frames[allocator->current_frame];
+
+	if (frame.pools.empty())
+	{
+		auto pool = grab_descriptor_pool(allocator);
+		if (!pool)
+			return false;
+
+		frame.pools.push_back(pool);
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = frame.pools.back();
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &layout;
+
+	auto result = vkAllocateDescriptorSets(allocator->device, &allocateInfo, set);
+	if (result == VK_SUCCESS)
+		return true;
+
+	if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+		return false;
+
+	// The current pool is exhausted, grow by moving on to a fresh one
+	auto pool = grab_descriptor_pool(allocator);
+	if (!pool)
+		return false;
+
+	frame.pools.push_back(pool);
+	allocateInfo.descriptorPool = pool;
+
+	return vkAllocateDescriptorSets(allocator->device, &allocateInfo, set) == VK_SUCCESS;
+}
+
+VkDescriptorSetLayout get_descriptor_set_layout(DescriptorAllocator *allocator, const VkDescriptorSetLayoutBinding *bindings, uint32_t binding_count)
+{
+	DescriptorLayoutKey key;
+	key.bindings.assign(bindings, bindings + binding_count);
+
+	std::sort(key.bindings.begin(), key.bindings.end(), [](const VkDescriptorSetLayoutBinding &a, const VkDescriptorSetLayoutBinding &b) {
+		return a.binding < b.binding;
+	});
+
+	// The key owns its own copy of the immutable samplers so it never points into caller memory
+	for (auto &binding : key.bindings)
+	{
+		std::vector<VkSampler> samplers;
+		if (binding.pImmutableSamplers)
+			samplers.assign(binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+
+		key.immutable_samplers.push_back(std::move(samplers));
+		binding.pImmutableSamplers = nullptr;
+	}
+
+	auto cached = allocator->layout_cache.find(key);
+	if (cached != allocator->layout_cache.end())
+		return cached->second;
+
+	auto layout_bindings = key.bindings;
+	for (size_t i = 0; i < layout_bindings.size(); i++)
+	{
+		if (!key.immutable_samplers[i].empty())
+			layout_bindings[i].pImmutableSamplers = key.immutable_samplers[i].data();
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = binding_count;
+	layoutCreateInfo.pBindings = layout_bindings.data();
+
+	VkDescriptorSetLayout layout;
+	if (vkCreateDescriptorSetLayout(allocator->device, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	allocator->layout_cache.emplace(std::move(key), layout);
+
+	return layout;
+}
+
+void destroy_descriptor_allocator(DescriptorAllocator *allocator)
+{
+	for (auto &frame : allocator->frames)
+	{
+		for (auto pool : frame.pools)
+			vkDestroyDescriptorPool(allocator->device, pool, nullptr);
+
+		frame.pools.clear();
+	}
+
+	for (auto pool : allocator->free_pools)
+		vkDestroyDescriptorPool(allocator->device, pool, nullptr);
+
+	allocator->free_pools.clear();
+
+	for (auto &entry : allocator->layout_cache)
+		vkDestroyDescriptorSetLayout(allocator->device, entry.second, nullptr);
+
+	allocator->layout_cache.clear();
+}
+
+bool create_bindless_descriptors(CreateBindlessDescriptorsInfo *create_info, Device *device, BindlessDescriptors *bindless)
+{
+	if (!device->bindlessEnabled || create_info->frames_in_flight == 0)
+		return false;
+
+	VkPhysicalDeviceDescriptorIndexingProperties indexing_properties = {};
+	indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &indexing_properties;
+
+	vkGetPhysicalDeviceProperties2(device->physicalDevice, &properties);
+
+	// Combined image samplers count against both the sampler and sampled image limits, and with
+	// every stage enabled the per-stage limits apply as well
+	auto max_resources = indexing_properties.maxPerStageUpdateAfterBindResources;
+
+	auto max_textures = std::min({
+		create_info->max_textures,
+		indexing_properties.maxDescriptorSetUpdateAfterBindSamplers,
+		indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+		indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+		indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		max_resources / 2,
+	});
+
+	auto max_buffers = std::min({
+		create_info->max_buffers,
+		indexing_properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+		indexing_properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+		max_resources - max_textures,
+	});
+
+	bindless->device = device->logicalDevice;
+	bindless->current_frame = 0;
+
+	for (auto slots : { &bindless->textures, &bindless->buffers })
+	{
+		slots->next = 0;
+		slots->free.clear();
+		slots->retired.assign(create_info->frames_in_flight, {});
+	}
+
+	bindless->textures.max = max_textures;
+	bindless->textures.in_use.assign(max_textures, false);
+	bindless->buffers.max = max_buffers;
+	bindless->buffers.in_use.assign(max_buffers, false);
+
+	VkDescriptorSetLayoutBinding bindings[2] = {};
+	bindings[0].binding = BINDLESS_TEXTURE_BINDING;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = bindless->textures.max;
+	bindings[0].stageFlags = create_info->stages;
+	bindings[1].binding = BINDLESS_BUFFER_BINDING;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[1].descriptorCount = bindless->buffers.max;
+	bindings[1].stageFlags = create_info->stages;
+
+	VkDescriptorBindingFlags binding_flags[2] = {
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+	};
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {};
+	bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsCreateInfo.bindingCount = 2;
+	bindingFlagsCreateInfo.pBindingFlags = binding_flags;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+	layoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutCreateInfo.bindingCount = 2;
+	layoutCreateInfo.pBindings = bindings;
+
+	if (vkCreateDescriptorSetLayout(bindless->device, &layoutCreateInfo, nullptr, &bindless->layout) != VK_SUCCESS)
+		return false;
+
+	VkDescriptorPoolSize pool_sizes[2] = {
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, bindless->textures.max },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bindless->buffers.max },
+	};
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolCreateInfo.maxSets = 1;
+	poolCreateInfo.poolSizeCount = 2;
+	poolCreateInfo.pPoolSizes = pool_sizes;
+
+	if (vkCreateDescriptorPool(bindless->device, &poolCreateInfo, nullptr, &bindless->pool) != VK_SUCCESS)
+		return false;
+
+	VkDescriptorSetAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = bindless->pool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &bindless->layout;
+
+	if (vkAllocateDescriptorSets(bindless->device, &allocateInfo, &bindless->set) != VK_SUCCESS)
+		return false;
+
+	return true;
+}
+
+void begin_bindless_frame(BindlessDescriptors *bindless, uint32_t frame_index)
+{
+	bindless->current_frame = frame_index % (uint32_t)bindless->textures.retired.size();
+
+	// The frame that last used this slot has retired, so handles released during it can be reused
+	for (auto slots : { &bindless->textures, &bindless->buffers })
+	{
+		auto &retired = slots->retired[bindless->current_frame];
+		slots->free.insert(slots->free.end(), retired.begin(), retired.end());
+		retired.clear();
+	}
+}
+
+uint32_t take_bindless_slot(BindlessSlots *slots)
+{
+	uint32_t slot;
+
+	if (!slots->free.empty())
+	{
+		slot = slots->free.back();
+		slots->free.pop_back();
+	}
+	else if (slots->next < slots->max)
+	{
+		slot = slots->next++;
+	}
+	else
+	{
+		return BINDLESS_INVALID_HANDLE;
+	}
+
+	slots->in_use[slot] = true;
+
+	return slot;
+}
+
+bool release_bindless_slot(BindlessSlots *slots, uint32_t current_frame, uint32_t handle)
+{
+	if (handle >= slots->max || !slots->in_use[handle])
+		return false;
+
+	slots->in_use[handle] = false;
+	slots->retired[current_frame].push_back(handle);
+
+	return true;
+}
+
+uint32_t register_bindless_texture(BindlessDescriptors *bindless, VkImageView image_view, VkSampler sampler, VkImageLayout image_layout)
+{
+	auto handle = take_bindless_slot(&bindless->textures);
+	if (handle == BINDLESS_INVALID_HANDLE)
+	{
+		TRACE("bindless texture array is full");
+		return handle;
+	}
+
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.sampler = sampler;
+	imageInfo.imageView = image_view;
+	imageInfo.imageLayout = image_layout;
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = bindless->set;
+	write.dstBinding = BINDLESS_TEXTURE_BINDING;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets(bindless->device, 1, &write, 0, nullptr);
+
+	return handle;
+}
+
+uint32_t register_bindless_buffer(BindlessDescriptors *bindless, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	auto handle = take_bindless_slot(&bindless->buffers);
+	if (handle == BINDLESS_INVALID_HANDLE)
+	{
+		TRACE("bindless buffer array is full");
+		return handle;
+	}
+
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer = buffer;
+	bufferInfo.offset = offset;
+	bufferInfo.range = range;
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = bindless->set;
+	write.dstBinding = BINDLESS_BUFFER_BINDING;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo = &bufferInfo;
+
+	vkUpdateDescriptorSets(bindless->device, 1, &write, 0, nullptr);
+
+	return handle;
+}
+
+// Released slots are only recycled, never rewritten here; partially bound lets stale entries sit
+// untouched as long as shaders stop indexing them. Returns false for handles that are not registered.
+bool release_bindless_texture(BindlessDescriptors *bindless, uint32_t handle)
+{
+	return release_bindless_slot(&bindless->textures, bindless->current_frame, handle);
+}
+
+bool release_bindless_buffer(BindlessDescriptors *bindless, uint32_t handle)
+{
+	return release_bindless_slot(&bindless->buffers, bindless->current_frame, handle);
+}
+
+void destroy_bindless_descriptors(BindlessDescriptors *bindless)
+{
+	if (bindless->pool)
+	{
+		vkDestroyDescriptorPool(bindless->device, bindless->pool, nullptr);
+		bindless->pool = VK_NULL_HANDLE;
+		bindless->set = VK_NULL_HANDLE;
+	}
+
+	if (bindless->layout)
+	{
+		vkDestroyDescriptorSetLayout(bindless->device, bindless->layout, nullptr);
+		bindless->layout = VK_NULL_HANDLE;
+	}
+
+	bindless->textures = BindlessSlots();
+	bindless->buffers = BindlessSlots();
+}
@@ -1,5 +1,7 @@
 #include "renderer/device.h"
 
+#include <string.h>
+
 std::vector<const char*> load_extensions(bool enableValidation)
 {
 	std::vector<const char*> extensions;
@@ -40,13 +42,13 @@ std::vector<const char*> load_layers(bool enableValidation)
 
 bool create_instance(CreateDeviceInfo* create_device_info, Device* device)
 {
-    VkApplicationInfo appInfo;
+    VkApplicationInfo appInfo = {};
 	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
 	appInfo.pApplicationName = create_device_info->application_name;
 	appInfo.pEngineName = create_device_info->engine_name;
 	appInfo.apiVersion = VK_HEADER_VERSION_COMPLETE;
 
-	VkInstanceCreateInfo instanceCreateInfo;
+	VkInstanceCreateInfo instanceCreateInfo = {};
 	instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	instanceCreateInfo.pNext = NULL;
 	instanceCreateInfo.pApplicationInfo = &appInfo;
@@ -61,6 +63,8 @@ bool create_instance(CreateDeviceInfo* create_device_info, Device* device)
 
 	if (vkCreateInstance(&instanceCreateInfo, nullptr, &device->instance) != VK_SUCCESS)
 		return false;
+
+	return true;
 }
 
 bool create_debug_report_callback(CreateDeviceInfo* create_device_info, Device* device)
@@ -120,27 +124,235 @@ bool create_debug_report_callback(CreateDeviceInfo* create_device_info, Device*
 	return true;
 }
 
+bool find_graphics_queue_family(VkPhysicalDevice physical_device, uint32_t* queue_family_index)
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &count, nullptr);
+
+	std::vector<VkQueueFamilyProperties> families(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &count, families.data());
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+		{
+			*queue_family_index = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool pick_physical_device(Device* device)
+{
+	uint32_t count = 0;
+	if (vkEnumeratePhysicalDevices(device->instance, &count, nullptr) != VK_SUCCESS || count == 0)
+		return false;
+
+	std::vector<VkPhysicalDevice> physical_devices(count);
+	if (vkEnumeratePhysicalDevices(device->instance, &count, physical_devices.data()) != VK_SUCCESS)
+		return false;
+
+	// Prefer a discrete gpu, but fall back to whatever has a graphics queue (e.g. lavapipe)
+	for (auto prefer_discrete : { true, false })
+	{
+		for (auto physical_device : physical_devices)
+		{
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+			if (prefer_discrete && properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+				continue;
+
+			uint32_t queue_family_index;
+			if (!find_graphics_queue_family(physical_device, &queue_family_index))
+				continue;
+
+			device->physicalDevice = physical_device;
+			device->graphicsQueueFamilyIndex = queue_family_index;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool has_device_extension(VkPhysicalDevice physical_device, const char* extension_name)
+{
+	uint32_t count = 0;
+	vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &count, nullptr);
+
+	std::vector<VkExtensionProperties> extensions(count);
+	vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &count, extensions.data());
+
+	for (auto &extension : extensions)
+	{
+		if (strcmp(extension.extensionName, extension_name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+// Descriptor indexing is core from 1.2, older devices need VK_EXT_descriptor_indexing (which itself needs maintenance3 from 1.1)
+bool supports_bindless(VkPhysicalDevice physical_device, bool* needs_extension)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+	if (properties.apiVersion < VK_API_VERSION_1_1)
+		return false;
+
+	*needs_extension = properties.apiVersion < VK_API_VERSION_1_2;
+	if (*needs_extension && !has_device_extension(physical_device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+		return false;
+
+	VkPhysicalDeviceDescriptorIndexingFeatures indexing_features = {};
+	indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &indexing_features;
+
+	vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+	return indexing_features.runtimeDescriptorArray
+		&& indexing_features.descriptorBindingPartiallyBound
+		&& indexing_features.descriptorBindingSampledImageUpdateAfterBind
+		&& indexing_features.descriptorBindingStorageBufferUpdateAfterBind
+		&& indexing_features.shaderSampledImageArrayNonUniformIndexing;
+}
+
+bool create_logical_device(CreateDeviceInfo* create_device_info, Device* device)
+{
+	float queue_priority = 1.0f;
+
+	VkDeviceQueueCreateInfo queueCreateInfo = {};
+	queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueCreateInfo.queueFamilyIndex = device->graphicsQueueFamilyIndex;
+	queueCreateInfo.queueCount = 1;
+	queueCreateInfo.pQueuePriorities = &queue_priority;
+
+	VkDeviceCreateInfo deviceCreateInfo = {};
+	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceCreateInfo.queueCreateInfoCount = 1;
+	deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+
+	std::vector<const char*> extensions;
+
+	device->memoryBudgetEnabled = has_device_extension(device->physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	if (device->memoryBudgetEnabled)
+	{
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+
+	// Bindless needs update-after-bind, partially bound runtime arrays from descriptor indexing
+	VkPhysicalDeviceDescriptorIndexingFeatures indexing_features = {};
+	indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+	bool needs_extension = false;
+	device->bindlessEnabled = create_device_info->enableBindless && supports_bindless(device->physicalDevice, &needs_extension);
+	if (device->bindlessEnabled)
+	{
+		if (needs_extension)
+			extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+		indexing_features.runtimeDescriptorArray = VK_TRUE;
+		indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+		indexing_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		indexing_features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		indexing_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
+		deviceCreateInfo.pNext = &indexing_features;
+	}
+	else if (create_device_info->enableBindless)
+	{
+		TRACE("bindless descriptors not supported by device");
+	}
+
+	deviceCreateInfo.enabledExtensionCount = (uint32_t)extensions.size();
+	deviceCreateInfo.ppEnabledExtensionNames = extensions.data();
+
+	if (vkCreateDevice(device->physicalDevice, &deviceCreateInfo, nullptr, &device->logicalDevice) != VK_SUCCESS)
+		return false;
+
+	vkGetDeviceQueue(device->logicalDevice, device->graphicsQueueFamilyIndex, 0, &device->graphicsQueue);
+
+	return true;
+}
+
 bool create_device(CreateDeviceInfo* create_device_info, Device* device)
 {
 	if (!create_instance(create_device_info, device))
 		return false;
 
-	if (!create_debug_report_callback(create_device_info, device))
+	// Anything created so far is released again on failure, destroy_device skips what is still null
+	if (!create_debug_report_callback(create_device_info, device) || !pick_physical_device(device) || !create_logical_device(create_device_info, device))
+	{
+		destroy_device(device);
 		return false;
-
-	// PhysicalDevice
-	// LogicalDevice
+	}
 
     return true;
 }
 
+void update_memory_budget(Device* device, MemoryBudget* memory_budget)
+{
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties = {};
+	budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+	VkPhysicalDeviceMemoryProperties2 memory_properties = {};
+	memory_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+
+	if (device->memoryBudgetEnabled)
+		memory_properties.pNext = &budget_properties;
+
+	vkGetPhysicalDeviceMemoryProperties2(device->physicalDevice, &memory_properties);
+
+	auto heap_count = memory_properties.memoryProperties.memoryHeapCount;
+	memory_budget->heap_count = heap_count;
+	memory_budget->usage_reported = device->memoryBudgetEnabled;
+
+	for (uint32_t i = 0; i < heap_count; i++)
+	{
+		if (device->memoryBudgetEnabled)
+		{
+			memory_budget->budget[i] = budget_properties.heapBudget[i];
+			memory_budget->usage[i] = budget_properties.heapUsage[i];
+		}
+		else
+		{
+			memory_budget->budget[i] = memory_properties.memoryProperties.memoryHeaps[i].size;
+		}
+	}
+}
+
+void destroy_logical_device(Device* device)
+{
+	if (device->logicalDevice)
+	{
+		vkDestroyDevice(device->logicalDevice, nullptr);
+		device->logicalDevice = nullptr;
+		device->graphicsQueue = nullptr;
+	}
+}
+
 void destroy_device(Device* device)
 {
+	destroy_logical_device(device);
+
 	if (device->debugReportCallback)
 	{
 		vkDestroyDebugReportCallbackEXT(device->instance, device->debugReportCallback, nullptr);
 		device->debugReportCallback = nullptr;
 	}
 
-	vkDestroyInstance(device->instance, nullptr);
+	if (device->instance)
+	{
+		vkDestroyInstance(device->instance, nullptr);
+		device->instance = nullptr;
+	}
+
+	device->physicalDevice = nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "renderer/residency.h"
+
+#include <algorithm>
+#include <vector>
+
+bool track_resource(ResidencyManager *manager, uint64_t id, ResidencyKinds kind, uint32_t heap_index, VkDeviceSize size)
+{
+	if (heap_index >= VK_MAX_MEMORY_HEAPS)
+	{
+		TRACE("track_resource heap index out of range");
+		return false;
+	}
+
+	untrack_resource(manager, id);
+
+	manager->resources[id] = ResidentResource{
+		id : id,
+		kind : kind,
+		heap_index : heap_index,
+		size : size,
+		full_size : size,
+		last_used_frame : manager->current_frame,
+		state : ResidencyStates::ResidentState,
+	};
+
+	manager->tracked_usage[heap_index] += size;
+
+	return true;
+}
+
+void untrack_resource(ResidencyManager *manager, uint64_t id)
+{
+	auto found = manager->resources.find(id);
+	if (found == manager->resources.end())
+		return;
+
+	auto &resource = found->second;
+	if (resource.state != ResidencyStates::EvictedState)
+		manager->tracked_usage[resource.heap_index] -= resource.size;
+
+	manager->resources.erase(found);
+}
+
+// Anything but ResidentState means the caller should restore the resource and call make_resource_resident.
+// Untracked resources report EvictedState.
+ResidencyStates touch_resource(ResidencyManager *manager, uint64_t id)
+{
+	auto found = manager->resources.find(id);
+	if (found == manager->resources.end())
+		return ResidencyStates::EvictedState;
+
+	found->second.last_used_frame = manager->current_frame;
+
+	return found->second.state;
+}
+
+void make_resource_resident(ResidencyManager *manager, uint64_t id, VkDeviceSize size)
+{
+	auto found = manager->resources.find(id);
+	if (found == manager->resources.end())
+		return;
+
+	auto &resource = found->second;
+	if (resource.state != ResidencyStates::EvictedState)
+		manager->tracked_usage[resource.heap_index] -= resource.size;
+
+	resource.size = size;
+	resource.full_size = size;
+	resource.state = ResidencyStates::ResidentState;
+	resource.last_used_frame = manager->current_frame;
+
+	manager->tracked_usage[resource.heap_index] += size;
+}
+
+// Returns the heap usage left after evicting
+VkDeviceSize evict_heap(ResidencyManager *manager, uint32_t heap_index, VkDeviceSize usage, VkDeviceSize target)
+{
+	std::vector<ResidentResource *> candidates;
+
+	for (auto &entry : manager->resources)
+	{
+		auto &resource = entry.second;
+
+		if (resource.state == ResidencyStates::EvictedState || resource.heap_index != heap_index)
+			continue;
+
+		// last_used_frame is only ever stamped from current_frame, so this never underflows
+		if (manager->current_frame - resource.last_used_frame < manager->options.min_idle_frames)
+			continue;
+
+		candidates.push_back(&resource);
+	}
+
+	// Least recently used first, larger resources first among equally old ones
+	std::sort(candidates.begin(), candidates.end(), [](ResidentResource *a, ResidentResource *b) {
+		if (a->last_used_frame != b->last_used_frame)
+			return a->last_used_frame < b->last_used_frame;
+
+		return a->size > b->size;
+	});
+
+	for (auto resource : candidates)
+	{
+		if (usage <= target)
+			break;
+
+		auto freed = std::min(manager->options.evict(*resource), resource->size);
+		if (freed == 0)
+			continue;
+
+		usage -= std::min(freed, usage);
+		manager->tracked_usage[heap_index] -= freed;
+		manager->counters.evicted_bytes += freed;
+
+		if (freed == resource->size)
+		{
+			resource->size = 0;
+			resource->state = ResidencyStates::EvictedState;
+			manager->counters.evictions++;
+		}
+		else
+		{
+			resource->size -= freed;
+			resource->state = ResidencyStates::DemotedState;
+			manager->counters.demotions++;
+		}
+	}
+
+	return usage;
+}
+
+// Call at the end of each frame, after every resource used in it has been touched. Ends the frame,
+// later touches count towards the next one.
+void update_residency(ResidencyManager *manager, MemoryBudget *memory_budget)
+{
+	for (uint32_t i = 0; i < memory_budget->heap_count; i++)
+	{
+		// Without VK_EXT_memory_budget the resources we track are the only usage we know about
+		auto budget = memory_budget->budget[i];
+		auto usage = memory_budget->usage_reported ? memory_budget->usage[i] : manager->tracked_usage[i];
+
+		manager->counters.heap_budget[i] = budget;
+		manager->counters.heap_usage_before_eviction[i] = usage;
+
+		auto over_budget = usage > (VkDeviceSize)(budget * manager->options.budget_fraction);
+		if (manager->options.evict && over_budget)
+			usage = evict_heap(manager, i, usage, (VkDeviceSize)(budget * manager->options.target_fraction));
+
+		manager->counters.heap_usage[i] = usage;
+	}
+
+	manager->current_frame++;
+}
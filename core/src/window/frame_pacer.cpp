@@ -0,0 +1,209 @@
+#include "window/frame_pacer.h"
+
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+
+#include "stats.h"
+
+const int64_t NANOSECONDS_PER_SECOND = 1000000000;
+
+int64_t frame_pacer_now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (int64_t)time.tv_sec * NANOSECONDS_PER_SECOND + time.tv_nsec;
+}
+
+timespec to_timespec(int64_t time_ns)
+{
+    timespec time;
+    time.tv_sec = time_ns / NANOSECONDS_PER_SECOND;
+    time.tv_nsec = time_ns % NANOSECONDS_PER_SECOND;
+
+    return time;
+}
+
+bool create_frame_pacer(CreateFramePacerInfo *create_info, FramePacer *pacer)
+{
+    if (create_info->history_size == 0)
+        return false;
+
+    pacer->frame_interval_ns = create_info->target_fps > 0 ? NANOSECONDS_PER_SECOND / create_info->target_fps : 0;
+    pacer->spin_threshold_ns = (int64_t)create_info->spin_threshold_us * 1000;
+    pacer->next_deadline_ns = frame_pacer_now();
+    pacer->waiting = false;
+    pacer->last_present_ns = 0;
+    pacer->frames = 0;
+
+    pacer->history_size = create_info->history_size;
+    pacer->latency_history_ms.reserve(create_info->history_size);
+    pacer->frame_time_history_ms.reserve(create_info->history_size);
+    pacer->latency_cursor = 0;
+    pacer->frame_time_cursor = 0;
+
+    if (create_info->csv_path)
+    {
+        pacer->csv = fopen(create_info->csv_path, "w");
+        if (!pacer->csv)
+            return false;
+
+        fprintf(pacer->csv, "sample,frame,start_ms,present_ms,duration_ms\n");
+    }
+
+    return true;
+}
+
+// Sleeps until the next frame slot, so events are pumped and rendered right before the deadline
+// instead of input going stale while waiting on a fence or present
+void frame_pacer_wait(FramePacer *pacer)
+{
+    while (frame_pacer_wait_for_events(pacer, -1))
+    {
+    }
+}
+
+// Like frame_pacer_wait, but returns true as soon as fd becomes readable so the caller can read and
+// timestamp events the moment they arrive. Call it again until it returns false at the deadline.
+bool frame_pacer_wait_for_events(FramePacer *pacer, int fd)
+{
+    if (pacer->frame_interval_ns == 0)
+        return false;
+
+    if (!pacer->waiting)
+    {
+        pacer->next_deadline_ns += pacer->frame_interval_ns;
+
+        // After a long stall start over from now instead of rushing through the missed frames
+        auto now = frame_pacer_now();
+        if (now > pacer->next_deadline_ns + pacer->frame_interval_ns)
+            pacer->next_deadline_ns = now;
+
+        pacer->waiting = true;
+    }
+
+    auto wake_ns = pacer->next_deadline_ns - pacer->spin_threshold_ns;
+    auto now = frame_pacer_now();
+
+    if (now < wake_ns)
+    {
+        if (fd < 0)
+        {
+            auto wake = to_timespec(wake_ns);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR)
+            {
+            }
+        }
+        else
+        {
+            pollfd poll_fd = {};
+            poll_fd.fd = fd;
+            poll_fd.events = POLLIN;
+
+            // Interrupted polls also return to the caller, which just calls again
+            auto timeout = to_timespec(wake_ns - now);
+            if (ppoll(&poll_fd, 1, &timeout, NULL) != 0)
+                return true;
+        }
+    }
+
+    while (frame_pacer_now() < pacer->next_deadline_ns)
+    {
+    }
+
+    pacer->waiting = false;
+
+    return false;
+}
+
+void frame_pacer_input(FramePacer *pacer, int64_t received_ns)
+{
+    pacer->pending_inputs.push_back(received_ns);
+}
+
+void push_history(std::vector<double> *history, uint32_t *cursor, uint32_t history_size, double value)
+{
+    if (history->size() < history_size)
+    {
+        history->push_back(value);
+        return;
+    }
+
+    (*history)[*cursor] = value;
+    *cursor = (*cursor + 1) % history_size;
+}
+
+// One row per frame time and per input latency, so the distribution can be rebuilt from the raw samples
+void write_csv_sample(FramePacer *pacer, const char *sample, int64_t start_ns, int64_t present_ns)
+{
+    fprintf(pacer->csv, "%s,%lu,%.3f,%.3f,%.3f\n",
+        sample,
+        (unsigned long)pacer->frames,
+        start_ns / 1e6,
+        present_ns / 1e6,
+        (present_ns - start_ns) / 1e6);
+}
+
+void frame_pacer_present(FramePacer *pacer)
+{
+    auto now = frame_pacer_now();
+
+    if (pacer->last_present_ns != 0)
+    {
+        auto frame_time_ms = (now - pacer->last_present_ns) / 1e6;
+        push_history(&pacer->frame_time_history_ms, &pacer->frame_time_cursor, pacer->history_size, frame_time_ms);
+
+        if (pacer->csv)
+            write_csv_sample(pacer, "frame", pacer->last_present_ns, now);
+    }
+
+    for (auto input_ns : pacer->pending_inputs)
+    {
+        auto latency_ms = (now - input_ns) / 1e6;
+        push_history(&pacer->latency_history_ms, &pacer->latency_cursor, pacer->history_size, latency_ms);
+
+        if (pacer->csv)
+            write_csv_sample(pacer, "input", input_ns, now);
+    }
+
+    pacer->pending_inputs.clear();
+    pacer->last_present_ns = now;
+    pacer->frames++;
+}
+
+void frame_pacer_report(FramePacer *pacer, FramePacerReport *report)
+{
+    report->frames = pacer->frames;
+
+    auto &frame_times = pacer->frame_time_history_ms;
+    if (!frame_times.empty())
+    {
+        double sum = 0;
+        for (auto frame_time : frame_times)
+            sum += frame_time;
+
+        auto mean = sum / frame_times.size();
+
+        double squared = 0;
+        for (auto frame_time : frame_times)
+            squared += (frame_time - mean) * (frame_time - mean);
+
+        report->frame_time_mean_ms = mean;
+        report->frame_time_variance = squared / frame_times.size();
+    }
+
+    auto latencies = pacer->latency_history_ms;
+    report->latency_p50_ms = percentile(&latencies, 0.50);
+    report->latency_p90_ms = percentile(&latencies, 0.90);
+    report->latency_p99_ms = percentile(&latencies, 0.99);
+}
+
+void destroy_frame_pacer(FramePacer *pacer)
+{
+    if (pacer->csv)
+    {
+        fclose(pacer->csv);
+        pacer->csv = nullptr;
+    }
+}
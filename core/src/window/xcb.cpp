@@ -37,11 +37,63 @@ WindowHandle xcb_window_create(WindowOptions *options)
 
 void xcb_window_run_eventloop(WindowHandle *window, WindowOptions *options)
 {
+    // With a frame callback the loop must keep spinning, so only block on events when there is nothing to render
+    auto next_event = options->frame ? xcb_poll_for_event : xcb_wait_for_event;
+
+    // Events read while the pacer waits, with the time they came off the connection
+    std::deque<std::pair<xcb_generic_event_t *, int64_t>> received;
+
     while (!options->shutdown)
     {
-        xcb_generic_event_t *event;
-        while ((event = xcb_wait_for_event(window->connection)))
+        if (options->pacer)
+        {
+            // Keep the xcb queue drained while waiting, so input is stamped on arrival and the
+            // latency includes the time spent waiting for the frame slot
+            auto read_events = [&](xcb_generic_event_t *(*poll)(xcb_connection_t *)) {
+                auto received_ns = frame_pacer_now();
+
+                xcb_generic_event_t *event;
+                while ((event = poll(window->connection)))
+                    received.push_back({ event, received_ns });
+            };
+
+            auto fd = xcb_get_file_descriptor(window->connection);
+            while (true)
+            {
+                // Reply round trips (e.g. xcb_intern_atom_reply) pull events into the xcb queue without
+                // leaving the fd readable, so take those before waiting on it
+                read_events(xcb_poll_for_queued_event);
+
+                if (!frame_pacer_wait_for_events(options->pacer, fd))
+                    break;
+
+                read_events(xcb_poll_for_event);
+            }
+        }
+
+        while (true)
         {
+            xcb_generic_event_t *event;
+            int64_t received_ns;
+
+            if (!received.empty())
+            {
+                event = received.front().first;
+                received_ns = received.front().second;
+                received.pop_front();
+            }
+            else
+            {
+                event = next_event(window->connection);
+                received_ns = frame_pacer_now();
+            }
+
+            if (!event)
+                break;
+
+            if (options->pacer && (event->response_type == XCB_KEY_PRESS || event->response_type == XCB_BUTTON_PRESS))
+                frame_pacer_input(options->pacer, received_ns);
+
             if (event->response_type == XCB_KEY_PRESS)
             {
                 auto key_code = ((xcb_key_press_event_t *)event)->detail;
@@ -89,7 +141,13 @@ void xcb_window_run_eventloop(WindowHandle *window, WindowOptions *options)
 
             free(event);
         }
+
+        if (options->frame && !options->shutdown)
+            options->frame();
     }
+
+    for (auto &entry : received)
+        free(entry.first);
 }
 
 void xcb_window_set_title(WindowHandle *window, const char *title)
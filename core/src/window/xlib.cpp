@@ -3,6 +3,15 @@
 WindowHandle xlib_window_create(WindowOptions *options)
 {
     auto display = XOpenDisplay(NULL);
+    if (!display)
+    {
+        TRACE("FAILED to open display");
+        return WindowHandle{
+            window_id : 0,
+            display : nullptr,
+        };
+    }
+
     auto screen = DefaultScreen(display);
     auto root = RootWindow(display, screen);
     auto depth = DefaultDepth(display, DefaultScreen(display));
@@ -41,12 +50,56 @@ WindowHandle xlib_window_create(WindowOptions *options)
 
 void xlib_window_run_eventloop(WindowHandle *window, WindowOptions *options)
 {
+    // Events read while the pacer waits, with the time they came off the connection
+    std::deque<std::pair<XEvent, int64_t>> received;
+
     while (!options->shutdown)
     {
-        while (XPending(window->display) > 0)
+        if (options->pacer)
+        {
+            // Keep the xlib queue drained while waiting, so input is stamped on arrival and the
+            // latency includes the time spent waiting for the frame slot
+            auto read_events = [&](int mode) {
+                auto received_ns = frame_pacer_now();
+
+                while (XEventsQueued(window->display, mode) > 0)
+                {
+                    XEvent xevent;
+                    XNextEvent(window->display, &xevent);
+                    received.push_back({ xevent, received_ns });
+                }
+            };
+
+            auto fd = ConnectionNumber(window->display);
+            while (true)
+            {
+                // Round trips made while handling events or rendering (e.g. XInternAtom) pull events into
+                // the xlib queue without leaving the fd readable, so take those before waiting on it
+                read_events(QueuedAlready);
+
+                if (!frame_pacer_wait_for_events(options->pacer, fd))
+                    break;
+
+                read_events(QueuedAfterReading);
+            }
+        }
+
+        while (!received.empty() || XPending(window->display) > 0)
         {
             XEvent xevent;
-            XNextEvent(window->display, &xevent);
+            int64_t received_ns;
+
+            if (!received.empty())
+            {
+                xevent = received.front().first;
+                received_ns = received.front().second;
+                received.pop_front();
+            }
+            else
+            {
+                XNextEvent(window->display, &xevent);
+                received_ns = frame_pacer_now();
+            }
 
             if (xevent.type == DestroyNotify || xevent.type == UnmapNotify)
             {
@@ -54,6 +107,9 @@ void xlib_window_run_eventloop(WindowHandle *window, WindowOptions *options)
                 break;
             }
 
+            if (options->pacer && (xevent.type == KeyPress || xevent.type == ButtonPress))
+                frame_pacer_input(options->pacer, received_ns);
+
             if (xevent.type == KeyPress)
             {
                 auto key_code = xevent.xkey.keycode;
@@ -99,6 +155,9 @@ void xlib_window_run_eventloop(WindowHandle *window, WindowOptions *options)
                     options->lost_focus();
             }
         }
+
+        if (options->frame && !options->shutdown)
+            options->frame();
     }
 }
 
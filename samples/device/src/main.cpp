@@ -7,6 +7,7 @@ int main()
     create_device_info.application_name = "test";
     create_device_info.engine_name = "test";
     create_device_info.enableValidation = false;
+    create_device_info.enableBindless = true;
 
     Device device;
     if (!create_device(&create_device_info, &device))
@@ -15,5 +16,53 @@ int main()
         return 0;
     }
 
+    MemoryBudget memory_budget;
+    update_memory_budget(&device, &memory_budget);
+
+    for (uint32_t i = 0; i < memory_budget.heap_count; i++)
+        std::cout << "heap " << i << " usage " << memory_budget.usage[i] << " of " << memory_budget.budget[i] << std::endl;
+
+    CreateDescriptorAllocatorInfo create_allocator_info;
+
+    DescriptorAllocator allocator;
+    if (!create_descriptor_allocator(&create_allocator_info, &device, &allocator))
+    {
+        TRACE("FAILED to create descriptor allocator");
+        return 0;
+    }
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    auto layout = get_descriptor_set_layout(&allocator, &binding, 1);
+
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        begin_descriptor_frame(&allocator, frame);
+
+        // Enough sets to spill over into a second pool
+        for (uint32_t i = 0; i < create_allocator_info.sets_per_pool + 1; i++)
+        {
+            VkDescriptorSet set;
+            if (!allocate_descriptor_set(&allocator, layout, &set))
+                TRACE("FAILED to allocate descriptor set");
+        }
+    }
+
+    if (device.bindlessEnabled)
+    {
+        CreateBindlessDescriptorsInfo create_bindless_info;
+
+        BindlessDescriptors bindless;
+        if (!create_bindless_descriptors(&create_bindless_info, &device, &bindless))
+            TRACE("FAILED to create bindless descriptors");
+
+        destroy_bindless_descriptors(&bindless);
+    }
+
+    destroy_descriptor_allocator(&allocator);
     destroy_device(&device);
-}
\ No newline at end of file
+}
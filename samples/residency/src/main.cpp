@@ -0,0 +1,143 @@
+#include <iostream>
+
+#include "platform.h"
+#include "renderer/residency.h"
+
+// Drives the eviction policy against a simulated 256MB heap, no gpu needed.
+// Returns non-zero when the policy misbehaves.
+int main()
+{
+    const VkDeviceSize MB = 1024 * 1024;
+    const uint64_t FRAMES = 32;
+    const uint64_t USED_PER_FRAME = 4;
+
+    MemoryBudget heap;
+    heap.heap_count = 1;
+    heap.budget[0] = 256 * MB;
+    heap.usage_reported = false;
+
+    ResidencyManager manager;
+
+    bool failed = false;
+    VkDeviceSize released = 0;
+
+    manager.options.evict = [&](const ResidentResource &resource) -> VkDeviceSize {
+        if (manager.current_frame - resource.last_used_frame < manager.options.min_idle_frames)
+        {
+            std::cout << "FAILED resource " << resource.id << " evicted while in use" << std::endl;
+            failed = true;
+        }
+
+        // Textures drop their top mip level (roughly 3/4 of the memory), buffers are freed outright
+        auto freed = resource.size;
+        if (resource.kind == ResidencyKinds::TextureResource && resource.size > MB)
+            freed = resource.size - resource.size / 4;
+
+        released += freed;
+        return freed;
+    };
+
+    auto target = (VkDeviceSize)(heap.budget[0] * manager.options.target_fraction);
+    auto limit = (VkDeviceSize)(heap.budget[0] * manager.options.budget_fraction);
+
+    for (uint64_t frame = 0; frame < FRAMES; frame++)
+    {
+        // Every frame streams in a new 16MB texture and keeps using the last few
+        track_resource(&manager, frame, ResidencyKinds::TextureResource, 0, 16 * MB);
+
+        for (uint64_t id = (frame >= USED_PER_FRAME ? frame - USED_PER_FRAME : 0); id <= frame; id++)
+        {
+            if (touch_resource(&manager, id) != ResidencyStates::ResidentState)
+                make_resource_resident(&manager, id, 16 * MB);
+        }
+
+        update_residency(&manager, &heap);
+
+        auto before = manager.counters.heap_usage_before_eviction[0];
+        auto after = manager.counters.heap_usage[0];
+
+        std::cout << "frame " << frame
+            << " usage " << before / MB << "MB -> " << after / MB << "MB"
+            << " of " << manager.counters.heap_budget[0] / MB << "MB"
+            << " evictions " << manager.counters.evictions
+            << " demotions " << manager.counters.demotions
+            << " evicted " << manager.counters.evicted_bytes / MB << "MB" << std::endl;
+
+        if (before > limit && after > target)
+        {
+            std::cout << "FAILED usage stayed above target after eviction" << std::endl;
+            failed = true;
+        }
+
+        if (after > limit)
+        {
+            std::cout << "FAILED usage left above budget" << std::endl;
+            failed = true;
+        }
+    }
+
+    if (manager.counters.evictions == 0 || manager.counters.demotions == 0)
+    {
+        std::cout << "FAILED expected both evictions and demotions" << std::endl;
+        failed = true;
+    }
+
+    if (manager.counters.evicted_bytes != released)
+    {
+        std::cout << "FAILED evicted bytes do not match what was released" << std::endl;
+        failed = true;
+    }
+
+    // Using a demoted texture again has to be reported, so its mips can be restored
+    const ResidentResource *demoted = nullptr;
+    for (auto &entry : manager.resources)
+    {
+        if (entry.second.state == ResidencyStates::DemotedState)
+            demoted = &entry.second;
+    }
+
+    if (!demoted)
+    {
+        std::cout << "FAILED no demoted resource left to promote" << std::endl;
+        failed = true;
+    }
+    else
+    {
+        auto id = demoted->id;
+        auto full_size = demoted->full_size;
+        auto usage = manager.tracked_usage[0];
+        auto restored = full_size - demoted->size;
+
+        if (touch_resource(&manager, id) != ResidencyStates::DemotedState)
+        {
+            std::cout << "FAILED touching a demoted resource did not report it" << std::endl;
+            failed = true;
+        }
+
+        make_resource_resident(&manager, id, full_size);
+
+        if (touch_resource(&manager, id) != ResidencyStates::ResidentState || manager.resources[id].size != full_size)
+        {
+            std::cout << "FAILED demoted resource was not promoted again" << std::endl;
+            failed = true;
+        }
+
+        if (manager.tracked_usage[0] != usage + restored)
+        {
+            std::cout << "FAILED promotion did not account for the restored bytes" << std::endl;
+            failed = true;
+        }
+    }
+
+    if (track_resource(&manager, FRAMES, ResidencyKinds::BufferResource, VK_MAX_MEMORY_HEAPS, MB))
+    {
+        std::cout << "FAILED out of range heap index was accepted" << std::endl;
+        failed = true;
+    }
+
+    if (failed)
+        return 1;
+
+    std::cout << "residency policy ok" << std::endl;
+    return 0;
+}
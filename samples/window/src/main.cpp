@@ -1,4 +1,5 @@
 #include <string.h>
+#include <stdlib.h>
 #include <iostream>
 
 #include "platform.h"
@@ -8,6 +9,18 @@ int main()
 {
     WindowHandle window;
 
+    CreateFramePacerInfo create_pacer_info;
+    create_pacer_info.target_fps = 60;
+    // Per-frame timings are only written out when asked for, e.g. FRAME_PACING_CSV=frame_pacing.csv
+    create_pacer_info.csv_path = getenv("FRAME_PACING_CSV");
+
+    FramePacer pacer;
+    if (!create_frame_pacer(&create_pacer_info, &pacer))
+    {
+        TRACE("FAILED to create frame pacer");
+        return 0;
+    }
+
     WindowOptions options = {
         key_pressed: [&](uint32_t key_code) {
             std::cout << "clicked key " << key_code << std::endl;
@@ -48,6 +61,22 @@ int main()
         lost_focus: []() {
             std::cout << "lost focus" << std::endl;
         },
+        frame: [&]() {
+            // Rendering and vkQueuePresentKHR would go here
+            frame_pacer_present(&pacer);
+
+            if (pacer.frames % 60 == 0) {
+                FramePacerReport report;
+                frame_pacer_report(&pacer, &report);
+
+                std::cout << "frame time " << report.frame_time_mean_ms << "ms"
+                    << " variance " << report.frame_time_variance
+                    << " input latency p50 " << report.latency_p50_ms << "ms"
+                    << " p90 " << report.latency_p90_ms << "ms"
+                    << " p99 " << report.latency_p99_ms << "ms" << std::endl;
+            }
+        },
+        pacer: &pacer,
     };
 
     window = create_window(&options);
@@ -57,4 +86,6 @@ int main()
     run_window_eventloop(&window, &options);
 
     close_window(&window);
+
+    destroy_frame_pacer(&pacer);
 }
\ No newline at end of file